@@ -18,3 +18,13 @@ V = @
 # following line and set it to the full path to QEMU.
 #
 # QEMU=
+
+# To change the number of pages in each kernel stack (default 8),
+# uncomment the following line.
+#
+# KSTKPAGES=8
+
+# To run the serial console at a different speed (default 115200),
+# uncomment the following line.
+#
+# SERIAL_BAUD=9600
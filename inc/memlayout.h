@@ -94,7 +94,10 @@
 
 // Kernel stack.
 #define KSTACKTOP	KERNBASE
-#define KSTKSIZE	(8*PGSIZE)   		// size of a kernel stack
+#ifndef KSTKPAGES
+#define KSTKPAGES	8			// pages per kernel stack
+#endif
+#define KSTKSIZE	(KSTKPAGES*PGSIZE)	// size of a kernel stack
 #define KSTKGAP		(8*PGSIZE)   		// size of a kernel stack guard
 
 // Memory-mapped IO.
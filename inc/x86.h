@@ -9,6 +9,13 @@ breakpoint(void)
 	asm volatile("int3");
 }
 
+// Spin-wait hint: lets the CPU (or a hypervisor) back off a busy loop.
+static inline void
+pause(void)
+{
+	asm volatile("pause");
+}
+
 static inline uint8_t
 inb(int port)
 {
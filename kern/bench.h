@@ -0,0 +1,11 @@
+#ifndef JOS_KERN_BENCH_H
+#define JOS_KERN_BENCH_H
+#ifndef JOS_KERNEL
+# error "This is a JOS kernel header; user programs should not #include it"
+#endif
+
+// Run the kernel microbenchmark called 'name', or all of them if 'name'
+// is NULL.  Returns -1 if there is no benchmark by that name.
+int bench_run(const char *name);
+
+#endif	// !JOS_KERN_BENCH_H
@@ -40,7 +40,11 @@ delay(void)
 #define COM_IER		1	// Out: Interrupt Enable Register
 #define   COM_IER_RDI	0x01	//   Enable receiver data interrupt
 #define COM_IIR		2	// In:	Interrupt ID Register
+#define   COM_IIR_FIFO	0xC0	//   FIFOs enabled and working
 #define COM_FCR		2	// Out: FIFO Control Register
+#define   COM_FCR_ENABLE 0x01	//   Enable FIFOs
+#define   COM_FCR_RCLR	0x02	//   Clear receive FIFO
+#define   COM_FCR_TCLR	0x04	//   Clear transmit FIFO
 #define COM_LCR		3	// Out: Line Control Register
 #define	  COM_LCR_DLAB	0x80	//   Divisor latch access bit
 #define	  COM_LCR_WLEN8	0x03	//   Wordlength: 8 bits
@@ -53,7 +57,27 @@ delay(void)
 #define   COM_LSR_TXRDY	0x20	//   Transmit buffer avail
 #define   COM_LSR_TSRE	0x40	//   Transmitter off
 
+#define COM_FIFOSIZE	16	// 16550 transmit FIFO depth
+
+#ifndef SERIAL_BAUD
+#define SERIAL_BAUD	115200
+#endif
+#if SERIAL_BAUD <= 0 || SERIAL_BAUD > 115200 || 115200 % SERIAL_BAUD != 0
+#error "SERIAL_BAUD must divide 115200"
+#endif
+
 static bool serial_exists;
+static int serial_burst = 1;	// bytes we may write once THR is empty
+
+// Serial output is queued here and fed to the UART a FIFO-full at a
+// time, so writers only wait on the UART when the ring is full.
+#define SERIAL_TXBUFSIZE 512
+
+static struct {
+	uint8_t buf[SERIAL_TXBUFSIZE];
+	uint32_t rpos;
+	uint32_t wpos;
+} serial_tx;
 
 static int
 serial_proc_data(void)
@@ -63,36 +87,76 @@ serial_proc_data(void)
 	return inb(COM1+COM_RX);
 }
 
+// Move queued output into the UART.  If the UART is busy, either give
+// up or, if 'wait' is set, wait for it a bounded time and then write
+// anyway, as a missing or stuck UART never becomes ready.
+static void
+serial_tx_drain(bool wait)
+{
+	int i;
+
+	if (serial_tx.rpos == serial_tx.wpos)
+		return;
+	if (!wait && !(inb(COM1 + COM_LSR) & COM_LSR_TXRDY))
+		return;
+	for (i = 0;
+	     !(inb(COM1 + COM_LSR) & COM_LSR_TXRDY) && i < 12800;
+	     i++)
+		delay();
+
+	// Once THR is empty the whole transmit FIFO is,
+	// so it can take a full burst without further polling.
+	for (i = 0; i < serial_burst && serial_tx.rpos != serial_tx.wpos; i++) {
+		outb(COM1 + COM_TX, serial_tx.buf[serial_tx.rpos++]);
+		if (serial_tx.rpos == SERIAL_TXBUFSIZE)
+			serial_tx.rpos = 0;
+	}
+}
+
 void
 serial_intr(void)
 {
 	if (serial_exists)
 		cons_intr(serial_proc_data);
+	serial_tx_drain(0);
 }
 
+// Write out everything still queued, for callers that may never
+// poll the console again.
 static void
-serial_putc(int c)
+serial_flush(void)
 {
-	int i;
-
-	for (i = 0;
-	     !(inb(COM1 + COM_LSR) & COM_LSR_TXRDY) && i < 12800;
-	     i++)
-		delay();
+	while (serial_tx.rpos != serial_tx.wpos)
+		serial_tx_drain(1);
+}
 
-	outb(COM1 + COM_TX, c);
+static void
+serial_putc(int c)
+{
+	uint32_t next;
+
+	next = serial_tx.wpos + 1;
+	if (next == SERIAL_TXBUFSIZE)
+		next = 0;
+	// Ring full: wait for the UART to make room
+	if (next == serial_tx.rpos)
+		serial_tx_drain(1);
+
+	serial_tx.buf[serial_tx.wpos] = c;
+	serial_tx.wpos = next;
+	serial_tx_drain(0);
 }
 
 static void
 serial_init(void)
 {
-	// Turn off the FIFO
-	outb(COM1+COM_FCR, 0);
+	// Turn on and clear the FIFOs
+	outb(COM1+COM_FCR, COM_FCR_ENABLE | COM_FCR_RCLR | COM_FCR_TCLR);
 
 	// Set speed; requires DLAB latch
 	outb(COM1+COM_LCR, COM_LCR_DLAB);
-	outb(COM1+COM_DLL, (uint8_t) (115200 / 9600));
-	outb(COM1+COM_DLM, 0);
+	outb(COM1+COM_DLL, (uint8_t) (115200 / SERIAL_BAUD));
+	outb(COM1+COM_DLM, (uint8_t) ((115200 / SERIAL_BAUD) >> 8));
 
 	// 8 data bits, 1 stop bit, parity off; turn off DLAB latch
 	outb(COM1+COM_LCR, COM_LCR_WLEN8 & ~COM_LCR_DLAB);
@@ -105,7 +169,9 @@ serial_init(void)
 	// Clear any preexisting overrun indications and interrupts
 	// Serial port doesn't exist if COM_LSR returns 0xFF
 	serial_exists = (inb(COM1+COM_LSR) != 0xFF);
-	(void) inb(COM1+COM_IIR);
+	// An 8250/16450 has no FIFO, so it takes one byte at a time
+	serial_burst = ((inb(COM1+COM_IIR) & COM_IIR_FIFO) == COM_IIR_FIFO
+			? COM_FIFOSIZE : 1);
 	(void) inb(COM1+COM_RX);
 
 }
@@ -133,9 +199,15 @@ lpt_putc(int c)
 
 /***** Text-mode CGA/VGA display output *****/
 
+// cga_putc() draws into the crt_buf shadow copy of the screen and
+// records which lines it changed in crt_dirty.  cga_flush() copies just
+// those lines to video memory and moves the hardware cursor once.
 static unsigned addr_6845;
-static uint16_t *crt_buf;
+static uint16_t *crt_mem;		// video memory
+static uint16_t crt_buf[CRT_SIZE];	// shadow of crt_mem
+static uint32_t crt_dirty;		// bit n set: line n differs from crt_mem
 static uint16_t crt_pos;
+static uint16_t crt_cursor;		// cursor position last sent to the 6845
 
 int cga_set_color(int foreground_color_, int background_color_){
 	if(foreground_color_ >= 0 && foreground_color_ <= 0xf){
@@ -180,8 +252,37 @@ cga_init(void)
 	outb(addr_6845, 15);
 	pos |= inb(addr_6845 + 1);
 
-	crt_buf = (uint16_t*) cp;
-	crt_pos = pos;
+	crt_mem = (uint16_t*) cp;
+	memmove(crt_buf, crt_mem, sizeof(crt_buf));
+	crt_pos = crt_cursor = pos;
+}
+
+// Mark the line holding screen position 'pos' as changed.
+static void
+cga_touch(unsigned pos)
+{
+	crt_dirty |= 1 << (pos / CRT_COLS);
+}
+
+static void
+cga_flush(void)
+{
+	int row;
+
+	for (row = 0; crt_dirty; row++, crt_dirty >>= 1)
+		if (crt_dirty & 1)
+			memmove(crt_mem + row * CRT_COLS, crt_buf + row * CRT_COLS,
+				CRT_COLS * sizeof(uint16_t));
+
+	if (crt_cursor == crt_pos)
+		return;
+	crt_cursor = crt_pos;
+
+	/* move that little blinky thing */
+	outb(addr_6845, 14);
+	outb(addr_6845 + 1, crt_pos >> 8);
+	outb(addr_6845, 15);
+	outb(addr_6845 + 1, crt_pos);
 }
 
 
@@ -197,12 +298,14 @@ cga_putc(int c)
 		if (crt_pos > 0) {
 			crt_pos--;
 			crt_buf[crt_pos] = (c & ~0xff) | ' ';
+			cga_touch(crt_pos);
 		}
 		break;
 	case '\n':
-		for(int i=crt_pos;i<((crt_pos / CRT_ROWS)+1) * CRT_COLS; ++i){
+		for(int i=crt_pos;i<((crt_pos / CRT_COLS)+1) * CRT_COLS; ++i){
 			crt_buf[i] = COLORIZE(foreground_color, background_color, ' ');
 		}
+		cga_touch(crt_pos);
 		crt_pos += CRT_COLS;
 		/* fallthru */
 	case '\r':
@@ -216,6 +319,7 @@ cga_putc(int c)
 		cons_putc(' ');
 		break;
 	default:
+		cga_touch(crt_pos);
 		crt_buf[crt_pos++] = COLORIZE(foreground_color, background_color, c);		/* write the character */
 		break;
 	}
@@ -228,13 +332,8 @@ cga_putc(int c)
 		for (i = CRT_SIZE - CRT_COLS; i < CRT_SIZE; i++)
 			crt_buf[i] = COLORIZE(LightGray, Black, ' ');
 		crt_pos -= CRT_COLS;
+		crt_dirty = (1 << CRT_ROWS) - 1;
 	}
-
-	/* move that little blinky thing */
-	outb(addr_6845, 14);
-	outb(addr_6845 + 1, crt_pos >> 8);
-	outb(addr_6845, 15);
-	outb(addr_6845 + 1, crt_pos);
 }
 
 
@@ -500,6 +599,32 @@ cons_putc(int c)
 	cga_putc(c);
 }
 
+// Screen updates are held back while a batch is open, so that a whole
+// cprintf reaches video memory and moves the cursor in one go.
+static int cons_batch;
+
+void
+cons_batch_begin(void)
+{
+	cons_batch++;
+}
+
+void
+cons_batch_end(void)
+{
+	if (--cons_batch == 0)
+		cga_flush();
+}
+
+// Push all pending output to the devices, waiting for the UART if
+// need be.  Used before the kernel stops polling the console.
+void
+cons_flush(void)
+{
+	cga_flush();
+	serial_flush();
+}
+
 // initialize the console devices
 void
 cons_init(void)
@@ -519,6 +644,8 @@ void
 cputchar(int c)
 {
 	cons_putc(c);
+	if (!cons_batch)
+		cga_flush();
 }
 
 int
@@ -526,8 +653,10 @@ getchar(void)
 {
 	int c;
 
+	// Interrupts are not enabled yet, so we cannot hlt until a key
+	// arrives; at least tell the CPU this is a spin-wait.
 	while ((c = cons_getc()) == 0)
-		/* do nothing */;
+		pause();
 	return c;
 }
 
@@ -19,6 +19,9 @@
 
 void cons_init(void);
 int cons_getc(void);
+void cons_batch_begin(void);
+void cons_batch_end(void);
+void cons_flush(void);
 
 void kbd_intr(void); // irq 1
 void serial_intr(void); // irq 4
@@ -3,6 +3,8 @@
 #include <inc/stdio.h>
 #include <inc/string.h>
 #include <inc/assert.h>
+#include <inc/memlayout.h>
+#include <inc/x86.h>
 
 #include <kern/monitor.h>
 #include <kern/console.h>
@@ -19,6 +21,21 @@ test_backtrace(int x)
 	cprintf("leaving test_backtrace %d\n", x);
 }
 
+// Unmap the KSTKGAP guard below the boot stack, so that a kernel stack
+// overflow faults instead of silently scribbling over kernel data.
+static void
+boot_stack_guard(void)
+{
+	extern char bootstackguard[], bootstack[];
+	extern pte_t entry_pgtable[];
+	char *va;
+
+	for (va = bootstackguard; va < bootstack; va += PGSIZE) {
+		entry_pgtable[PTX(va)] &= ~PTE_P;
+		invlpg(va);
+	}
+}
+
 void
 i386_init(void)
 {
@@ -29,6 +46,8 @@ i386_init(void)
 	// This ensures that all static/global variables start out zero.
 	memset(edata, 0, end - edata);
 
+	boot_stack_guard();
+
 	// Initialize the console.
 	// Can't call cprintf until after we do this!
 	cons_init();
@@ -71,6 +90,7 @@ _panic(const char *file, int line, const char *fmt,...)
 	vcprintf(fmt, ap);
 	cprintf("\n");
 	va_end(ap);
+	cons_flush();
 
 dead:
 	/* break into the kernel monitor */
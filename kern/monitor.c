@@ -10,6 +10,7 @@
 #include <kern/console.h>
 #include <kern/monitor.h>
 #include <kern/kdebug.h>
+#include <kern/bench.h>
 
 #define CMDBUF_SIZE	80	// enough for one VGA text line
 
@@ -25,7 +26,8 @@ static struct Command commands[] = {
 	{ "help", "Display this list of commands", mon_help },
 	{ "kerninfo", "Display information about the kernel", mon_kerninfo },
 	{ "backtrace", "Display the backtrace information in the stack", mon_backtrace},
-	{ "colors", "Display all the colors we have", mon_colors}
+	{ "colors", "Display all the colors we have", mon_colors},
+	{ "bench", "Run kernel microbenchmarks [name]", mon_bench }
 };
 
 /***** Implementations of basic kernel monitor commands *****/
@@ -95,6 +97,13 @@ mon_backtrace(int argc, char **argv, struct Trapframe *tf)
 }
 
 
+int
+mon_bench(int argc, char **argv, struct Trapframe *tf)
+{
+	if (bench_run(argc > 1 ? argv[1] : NULL) < 0)
+		cprintf("Unknown benchmark '%s'\n", argv[1]);
+	return 0;
+}
 
 /***** Kernel monitor command interpreter *****/
 
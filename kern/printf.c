@@ -5,6 +5,8 @@
 #include <inc/stdio.h>
 #include <inc/stdarg.h>
 
+#include <kern/console.h>
+
 
 static void
 putch(int ch, int *cnt)
@@ -18,7 +20,9 @@ vcprintf(const char *fmt, va_list ap)
 {
 	int cnt = 0;
 
+	cons_batch_begin();
 	vprintfmt((void*)putch, &cnt, fmt, ap);
+	cons_batch_end();
 	return cnt;
 }
 